@@ -0,0 +1,10 @@
+#ifndef BOUNDING_BOX_HPP
+#define BOUNDING_BOX_HPP
+
+struct BoundingBox {
+    int x_min, y_min, x_max, y_max;
+    float confidence;
+    int class_id;
+};
+
+#endif
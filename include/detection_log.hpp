@@ -0,0 +1,220 @@
+#ifndef DETECTION_LOG_HPP
+#define DETECTION_LOG_HPP
+
+#include "bounding_box.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * On-disk layout of the detection log (native little-endian, 8-byte aligned):
+ *
+ *   DetectionLogFileHeader
+ *   block 0: DetectionLogBlockHeader + payload
+ *   block 1: DetectionLogBlockHeader + payload
+ *   ...
+ *
+ * Each block holds up to a fixed number of frames stored column by column:
+ *
+ *   uint64_t frame_index[F]      int64_t timestamp[F]      uint32_t frame_offsets[F + 1]
+ *   int32_t  x_min[D]  y_min[D]  x_max[D]  y_max[D]  float confidence[D]  int32_t class_id[D]
+ *
+ * where frame_offsets[i]..frame_offsets[i + 1] is the range of detections of frame i.
+ * The block header keeps the time span and a class bitmap so queries skip whole blocks.
+ * Timestamps are non-decreasing across the log: DetectionLogWriter::Append() clamps a
+ * timestamp going backwards to the last logged one, so the readers can binary-search.
+ */
+struct DetectionLogFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct DetectionLogBlockHeader {
+    uint32_t magic;
+    uint32_t frameCount;
+    uint32_t detectionCount;
+    uint32_t reserved;
+    int64_t firstTimestamp;
+    int64_t lastTimestamp;
+    uint64_t classMask[2];      // Bit c set if class c appears; class ids >= 127 or < 0 share bit 127
+    uint64_t payloadBytes;      // Payload size following the header, padded to 8 bytes
+    uint64_t reserved2;
+};
+
+struct LoggedFrame {
+    uint64_t frameIndex;
+    int64_t timestamp;
+    std::vector<BoundingBox> detections;
+};
+
+/**
+ * @brief Appends per-frame detections to a columnar binary log
+ *
+ * Frames are accumulated into an in-memory block; full blocks are handed to a
+ * background thread that serializes and writes them, so Append() only copies
+ * the detections on the inference thread. Append() blocks only if the writer
+ * falls behind by more than DEFAULT_MAX_PENDING_BLOCKS blocks.
+ *
+ * Append() returns false once the log is closed or a write failed; a timestamp
+ * smaller than the previous one is clamped to it and the frame is still logged.
+ *
+ * Blocks are flushed to the OS whenever the writer thread drains its queue, so a
+ * crash loses the current partial block (up to framesPerBlock frames) plus any
+ * blocks still queued. Flush() bounds this: it writes the partial block and waits
+ * until everything appended so far has been written and flushed.
+ *
+ * @see DetectionLogReader Memory-mapped reader for the log
+ */
+class DetectionLogWriter {
+    public:
+        // ================================
+        // Constants
+        // ================================
+        static constexpr size_t DEFAULT_FRAMES_PER_BLOCK = 256;
+        static constexpr size_t DEFAULT_MAX_PENDING_BLOCKS = 64;
+
+        // ================================
+        // Functions
+        // ================================
+        DetectionLogWriter();
+
+        ~DetectionLogWriter();
+
+        bool Open(const std::string& path, size_t framesPerBlock = DEFAULT_FRAMES_PER_BLOCK);
+
+        bool Append(uint64_t frameIndex, int64_t timestamp, const std::vector<BoundingBox>& detections);
+
+        bool Flush();
+
+        void Close();
+
+        bool IsOpen() const { return m_isOpen; }
+
+    private:
+        // ================================
+        // Types
+        // ================================
+        struct Block {
+            std::vector<uint64_t> frameIndex;
+            std::vector<int64_t> timestamps;
+            std::vector<uint32_t> frameOffsets;
+            std::vector<int32_t> xMin, yMin, xMax, yMax;
+            std::vector<float> confidence;
+            std::vector<int32_t> classId;
+            uint64_t classMask[2];
+
+            void Clear();
+        };
+
+        // ================================
+        // Functions
+        // ================================
+        void SubmitCurrentBlock();
+
+        void WriterLoop();
+
+        bool WriteBlock(const Block& block);
+
+        // ================================
+        // Variables
+        // ================================
+        std::ofstream m_file;
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_pendingCv;
+        std::condition_variable m_spaceCv;
+        std::condition_variable m_flushedCv;
+        std::deque<Block> m_pending;
+        std::vector<Block> m_freeBlocks;
+        Block m_current;
+        size_t m_framesPerBlock;
+        bool m_isOpen;              // Only touched by the calling thread, m_file belongs to the writer thread
+        int64_t m_lastTimestamp;
+        uint64_t m_submittedBlocks;
+        uint64_t m_flushedBlocks;
+        bool m_stop;
+        std::atomic<bool> m_failed;
+};
+
+/**
+ * @brief Memory-mapped reader for logs written by DetectionLogWriter
+ *
+ * Open() maps the file and indexes the block headers only. Time-range queries
+ * binary-search the blocks and the timestamp column inside them; class queries
+ * additionally skip blocks whose class bitmap does not contain the class.
+ */
+class DetectionLogReader {
+    public:
+        // ================================
+        // Functions
+        // ================================
+        DetectionLogReader();
+
+        ~DetectionLogReader();
+
+        DetectionLogReader(const DetectionLogReader&) = delete;
+        DetectionLogReader& operator=(const DetectionLogReader&) = delete;
+
+        bool Open(const std::string& path);
+
+        void Close();
+
+        size_t GetBlockCount() const { return m_blocks.size(); }
+        uint64_t GetFrameCount() const { return m_frameCount; }
+        uint64_t GetDetectionCount() const { return m_detectionCount; }
+
+        std::vector<LoggedFrame> QueryTimeRange(int64_t begin, int64_t end) const;
+
+        std::vector<LoggedFrame> QueryClass(int classId,
+                                            int64_t begin = std::numeric_limits<int64_t>::min(),
+                                            int64_t end = std::numeric_limits<int64_t>::max()) const;
+
+        void ForEachFrame(const std::function<void(const LoggedFrame&)>& callback) const;
+
+    private:
+        // ================================
+        // Types
+        // ================================
+        struct BlockView {
+            const DetectionLogBlockHeader* header;
+            const uint64_t* frameIndex;
+            const int64_t* timestamps;
+            const uint32_t* frameOffsets;
+            const int32_t* xMin;
+            const int32_t* yMin;
+            const int32_t* xMax;
+            const int32_t* yMax;
+            const float* confidence;
+            const int32_t* classId;
+        };
+
+        // ================================
+        // Functions
+        // ================================
+        static bool ValidOffsets(const BlockView& block);
+
+        void Query(int classId, int64_t begin, int64_t end,
+                   const std::function<void(const LoggedFrame&)>& callback) const;
+
+        // ================================
+        // Variables
+        // ================================
+        int m_fd;
+        const uint8_t* m_data;
+        size_t m_size;
+        std::vector<BlockView> m_blocks;
+        uint64_t m_frameCount;
+        uint64_t m_detectionCount;
+};
+
+#endif
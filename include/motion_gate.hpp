@@ -0,0 +1,105 @@
+#ifndef MOTION_GATE_HPP
+#define MOTION_GATE_HPP
+
+#include "yolo_object_detector.hpp"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Thresholds controlling the motion gate
+ */
+struct MotionGateConfig {
+    int downsampleWidth = 160;          // Width of the difference image (height keeps the aspect ratio)
+    int pixelThreshold = 25;            // Gray-level change for a pixel to count as changed
+    float minChangedFraction = 0.001f;  // Changed-pixel fraction below which the frame is static
+    float fullFrameFraction = 0.5f;     // Region area fraction above which the full frame is used
+    int roiMargin = 32;                 // Margin (full-resolution pixels) around the changed region
+    int minRoiSize = 320;               // Minimum region side, avoids extreme upscaling in the letterbox
+    int keyframeInterval = 300;         // Force a full-frame inference every N frames (0 disables)
+};
+
+/**
+ * @brief Frame-difference gate for fixed cameras
+ *
+ * Each frame is downsampled to a small grayscale image and compared against the
+ * last frame that was sent to inference. The gate then decides whether to:
+ * - Skip inference entirely (no significant change, reuse the last detections)
+ * - Run inference on the bounding box of all changed pixels only, grown to cover
+ *   every previous detection it touches so static objects are never cropped
+ * - Run inference on the full frame (first frame, keyframe, or large change)
+ *
+ * The reference frame only advances when Commit() is called after a successful
+ * inference, so a failed inference keeps the change pending for the next frame.
+ *
+ * The frame is first decimated with a strided nearest-neighbour resize (reads only
+ * the sampled pixels) to twice the difference size, then averaged 2x2 with INTER_AREA
+ * (OpenCV's vectorized 2x path) and converted to gray on the small image. The time
+ * of every Update() is measured; see GetLastGateMicros() and GetAverageGateMicros().
+ *
+ * @see MotionGateConfig Thresholds used by the gate
+ */
+class MotionGate {
+    public:
+        // ================================
+        // Types
+        // ================================
+        enum class Decision {
+            Skip,       // Static frame, reuse the last detections
+            Roi,        // Run inference on the returned region only
+            FullFrame   // Run inference on the whole frame
+        };
+
+        // ================================
+        // Functions
+        // ================================
+        explicit MotionGate(const MotionGateConfig& config = MotionGateConfig());
+
+        Decision Update(const cv::Mat& frame, const std::vector<BoundingBox>& previous, cv::Rect& roi);
+
+        void Commit();
+
+        std::vector<BoundingBox> MergeDetections(const std::vector<BoundingBox>& previous,
+                                                 const std::vector<BoundingBox>& fresh,
+                                                 const cv::Rect& roi) const;
+
+        void Reset();
+
+        uint64_t GetFramesProcessed() const { return m_framesProcessed; }
+        uint64_t GetFramesSkipped() const { return m_framesSkipped; }
+        uint64_t GetRoiFrames() const { return m_roiFrames; }
+        float GetSkipRate() const;
+        double GetLastGateMicros() const { return m_lastGateMicros; }
+        double GetAverageGateMicros() const;
+
+    private:
+        // ================================
+        // Functions
+        // ================================
+        Decision Decide(const cv::Mat& frame, const std::vector<BoundingBox>& previous, cv::Rect& roi);
+
+        cv::Rect ExpandRegion(const cv::Rect& changed,
+                              const std::vector<BoundingBox>& previous,
+                              const cv::Size& frameSize) const;
+
+        // ================================
+        // Variables
+        // ================================
+        MotionGateConfig m_config;
+        cv::Mat m_decimated;
+        cv::Mat m_resized;
+        cv::Mat m_gray;
+        cv::Mat m_reference;
+        cv::Mat m_diff;
+        cv::Mat m_mask;
+        Decision m_pendingDecision;
+        bool m_hasPending;
+        int m_framesSinceFull;
+        uint64_t m_framesProcessed;
+        uint64_t m_framesSkipped;
+        uint64_t m_roiFrames;
+        double m_lastGateMicros;
+        double m_totalGateMicros;
+};
+
+#endif
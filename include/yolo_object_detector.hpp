@@ -2,16 +2,11 @@
 #define YOLO_OBJECT_DETECTOR_HPP
 
 #include "onnxinferencebase.hpp"
+#include "bounding_box.hpp"
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <string>
 
-struct BoundingBox {
-    int x_min, y_min, x_max, y_max;
-    float confidence;
-    int class_id;
-};
-
 /**
  * @brief Base class for YOLO object detection implementations
  * 
@@ -52,6 +47,14 @@ class YoloObjectDetector : public OnnxInferenceBase {
 
         bool DetectObjects(const cv::Mat& image, std::vector<Ort::Value>& outputTensor);
 
+        /**
+         * @brief Runs inference on a sub-region of the image only
+         *
+         * The region is letterboxed on its own; ParseOutput() maps the resulting
+         * boxes back to full-image coordinates through the region offset.
+         */
+        bool DetectObjects(const cv::Mat& image, const cv::Rect& roi, std::vector<Ort::Value>& outputTensor);
+
         virtual std::vector<BoundingBox> ParseOutput(const float* output,
                                                     int imageWidth,
                                                     int imageHeight,
@@ -76,6 +79,8 @@ class YoloObjectDetector : public OnnxInferenceBase {
         cv::Mat m_letterboxedImage;
         float m_scale;
         cv::Point m_pad;
+        cv::Point m_roiOffset;
+        cv::Size m_roiSize;
 };
 
 #endif
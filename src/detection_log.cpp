@@ -0,0 +1,464 @@
+#include "../include/detection_log.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // ================================
+    // Constants
+    // ================================
+    constexpr char FILE_MAGIC[8] = {'Y', 'O', 'L', 'O', 'D', 'L', 'O', 'G'};
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr uint32_t BLOCK_MAGIC = 0x314B4C42;   // "BLK1"
+    constexpr int CLASS_OVERFLOW_BIT = 127;
+    constexpr int ANY_CLASS = std::numeric_limits<int>::min();
+
+    static_assert(sizeof(DetectionLogFileHeader) == 16, "File header must keep blocks 8-byte aligned");
+    static_assert(sizeof(DetectionLogBlockHeader) == 64, "Block header must keep columns 8-byte aligned");
+
+    int ClassBit(int classId) {
+        return (classId >= 0 && classId < CLASS_OVERFLOW_BIT) ? classId : CLASS_OVERFLOW_BIT;
+    }
+
+    bool HasClass(const uint64_t classMask[2], int classId) {
+        int bit = ClassBit(classId);
+        return (classMask[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    size_t AlignTo8(size_t bytes) {
+        return (bytes + 7) & ~static_cast<size_t>(7);
+    }
+
+    size_t PayloadBytes(size_t frames, size_t detections) {
+        return AlignTo8(frames * (sizeof(uint64_t) + sizeof(int64_t)) +
+                        (frames + 1) * sizeof(uint32_t) +
+                        detections * (5 * sizeof(int32_t) + sizeof(float)));
+    }
+}
+
+// ================================
+// DetectionLogWriter
+// ================================
+
+void DetectionLogWriter::Block::Clear()
+{
+    frameIndex.clear();
+    timestamps.clear();
+    frameOffsets.assign(1, 0);
+    xMin.clear();
+    yMin.clear();
+    xMax.clear();
+    yMax.clear();
+    confidence.clear();
+    classId.clear();
+    classMask[0] = 0;
+    classMask[1] = 0;
+}
+
+DetectionLogWriter::DetectionLogWriter()
+    : m_framesPerBlock(DEFAULT_FRAMES_PER_BLOCK), m_isOpen(false),
+      m_lastTimestamp(std::numeric_limits<int64_t>::min()),
+      m_submittedBlocks(0), m_flushedBlocks(0), m_stop(false), m_failed(false)
+{
+    m_current.Clear();
+}
+
+DetectionLogWriter::~DetectionLogWriter()
+{
+    Close();
+}
+
+bool DetectionLogWriter::Open(const std::string& path, size_t framesPerBlock)
+{
+    Close();
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open()) {
+        std::cerr << "Error opening detection log: " << path << std::endl;
+        return false;
+    }
+
+    DetectionLogFileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    m_framesPerBlock = std::max<size_t>(1, framesPerBlock);
+    m_isOpen = true;
+    m_lastTimestamp = std::numeric_limits<int64_t>::min();
+    m_submittedBlocks = 0;
+    m_flushedBlocks = 0;
+    m_stop = false;
+    m_failed = false;
+    m_current.Clear();
+    m_thread = std::thread(&DetectionLogWriter::WriterLoop, this);
+    return true;
+}
+
+bool DetectionLogWriter::Append(uint64_t frameIndex, int64_t timestamp, const std::vector<BoundingBox>& detections)
+{
+    if (!m_isOpen || m_failed) {
+        return false;
+    }
+
+    // Keep the timestamps non-decreasing, the reader binary-searches on them
+    m_lastTimestamp = std::max(m_lastTimestamp, timestamp);
+
+    m_current.frameIndex.push_back(frameIndex);
+    m_current.timestamps.push_back(m_lastTimestamp);
+    for (const auto& detection : detections) {
+        m_current.xMin.push_back(detection.x_min);
+        m_current.yMin.push_back(detection.y_min);
+        m_current.xMax.push_back(detection.x_max);
+        m_current.yMax.push_back(detection.y_max);
+        m_current.confidence.push_back(detection.confidence);
+        m_current.classId.push_back(detection.class_id);
+
+        int bit = ClassBit(detection.class_id);
+        m_current.classMask[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    m_current.frameOffsets.push_back(static_cast<uint32_t>(m_current.classId.size()));
+
+    if (m_current.frameIndex.size() >= m_framesPerBlock) {
+        SubmitCurrentBlock();
+    }
+    return true;
+}
+
+bool DetectionLogWriter::Flush()
+{
+    if (!m_isOpen) {
+        return false;
+    }
+
+    SubmitCurrentBlock();
+
+    // Wait until the writer thread has written and flushed every submitted block
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_flushedCv.wait(lock, [this] { return m_flushedBlocks >= m_submittedBlocks || m_failed; });
+    return !m_failed;
+}
+
+void DetectionLogWriter::SubmitCurrentBlock()
+{
+    if (m_current.frameIndex.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_spaceCv.wait(lock, [this] { return m_pending.size() < DEFAULT_MAX_PENDING_BLOCKS || m_failed; });
+
+    // Hand the block to the writer thread and recycle a previously written one
+    m_pending.push_back(std::move(m_current));
+    m_submittedBlocks++;
+    if (!m_freeBlocks.empty()) {
+        m_current = std::move(m_freeBlocks.back());
+        m_freeBlocks.pop_back();
+    } else {
+        m_current = Block();
+    }
+    m_current.Clear();
+    lock.unlock();
+
+    m_pendingCv.notify_one();
+}
+
+void DetectionLogWriter::Close()
+{
+    if (!m_isOpen) {
+        return;
+    }
+
+    SubmitCurrentBlock();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_pendingCv.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    m_file.close();
+    m_pending.clear();
+    m_freeBlocks.clear();
+    m_isOpen = false;
+}
+
+void DetectionLogWriter::WriterLoop()
+{
+    uint64_t writtenBlocks = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_pendingCv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+        if (m_pending.empty()) {
+            break;
+        }
+
+        Block block = std::move(m_pending.front());
+        m_pending.pop_front();
+        lock.unlock();
+        m_spaceCv.notify_one();
+
+        bool written = WriteBlock(block);
+        writtenBlocks++;
+
+        // Flush to the OS once the queue is drained, rather than after every block
+        lock.lock();
+        bool drained = m_pending.empty();
+        lock.unlock();
+        if (written && drained) {
+            m_file.flush();
+            written = static_cast<bool>(m_file);
+        }
+
+        lock.lock();
+        m_freeBlocks.push_back(std::move(block));
+        if (!written) {
+            std::cerr << "Error writing detection log block" << std::endl;
+            m_failed = true;
+            m_pending.clear();
+            m_spaceCv.notify_all();
+            m_flushedCv.notify_all();
+        } else if (drained) {
+            m_flushedBlocks = writtenBlocks;
+            m_flushedCv.notify_all();
+        }
+    }
+}
+
+bool DetectionLogWriter::WriteBlock(const Block& block)
+{
+    size_t frames = block.frameIndex.size();
+    size_t detections = block.classId.size();
+
+    DetectionLogBlockHeader header{};
+    header.magic = BLOCK_MAGIC;
+    header.frameCount = static_cast<uint32_t>(frames);
+    header.detectionCount = static_cast<uint32_t>(detections);
+    header.firstTimestamp = block.timestamps.front();
+    header.lastTimestamp = block.timestamps.back();
+    header.classMask[0] = block.classMask[0];
+    header.classMask[1] = block.classMask[1];
+    header.payloadBytes = PayloadBytes(frames, detections);
+
+    auto writeColumn = [this](const auto& column) {
+        m_file.write(reinterpret_cast<const char*>(column.data()),
+                     column.size() * sizeof(column[0]));
+    };
+
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeColumn(block.frameIndex);
+    writeColumn(block.timestamps);
+    writeColumn(block.frameOffsets);
+    writeColumn(block.xMin);
+    writeColumn(block.yMin);
+    writeColumn(block.xMax);
+    writeColumn(block.yMax);
+    writeColumn(block.confidence);
+    writeColumn(block.classId);
+
+    size_t unpadded = frames * (sizeof(uint64_t) + sizeof(int64_t)) +
+                      (frames + 1) * sizeof(uint32_t) +
+                      detections * (5 * sizeof(int32_t) + sizeof(float));
+    static const char padding[8] = {};
+    m_file.write(padding, header.payloadBytes - unpadded);
+
+    return static_cast<bool>(m_file);
+}
+
+// ================================
+// DetectionLogReader
+// ================================
+
+DetectionLogReader::DetectionLogReader()
+    : m_fd(-1), m_data(nullptr), m_size(0), m_frameCount(0), m_detectionCount(0)
+{
+}
+
+DetectionLogReader::~DetectionLogReader()
+{
+    Close();
+}
+
+bool DetectionLogReader::Open(const std::string& path)
+{
+    Close();
+
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        std::cerr << "Error opening detection log: " << path << std::endl;
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(m_fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(DetectionLogFileHeader)) {
+        std::cerr << "Invalid detection log: " << path << std::endl;
+        Close();
+        return false;
+    }
+    m_size = static_cast<size_t>(fileStat.st_size);
+
+    void* mapped = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error mapping detection log: " << path << std::endl;
+        m_size = 0;
+        Close();
+        return false;
+    }
+    m_data = static_cast<const uint8_t*>(mapped);
+
+    const auto* fileHeader = reinterpret_cast<const DetectionLogFileHeader*>(m_data);
+    if (std::memcmp(fileHeader->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || fileHeader->version != FILE_VERSION) {
+        std::cerr << "Unsupported detection log format: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    // Index the block headers only; the columns stay on disk until queried
+    size_t offset = sizeof(DetectionLogFileHeader);
+    while (offset < m_size) {
+        const auto* header = reinterpret_cast<const DetectionLogBlockHeader*>(m_data + offset);
+        size_t payloadOffset = offset + sizeof(DetectionLogBlockHeader);
+        if (payloadOffset > m_size || header->magic != BLOCK_MAGIC ||
+            header->payloadBytes != PayloadBytes(header->frameCount, header->detectionCount) ||
+            header->payloadBytes > m_size - payloadOffset) {
+            std::cerr << "Detection log truncated at offset " << offset << ", ignoring the rest" << std::endl;
+            break;
+        }
+
+        size_t frames = header->frameCount;
+        size_t detections = header->detectionCount;
+        const uint8_t* column = m_data + payloadOffset;
+
+        BlockView view;
+        view.header = header;
+        view.frameIndex = reinterpret_cast<const uint64_t*>(column);
+        column += frames * sizeof(uint64_t);
+        view.timestamps = reinterpret_cast<const int64_t*>(column);
+        column += frames * sizeof(int64_t);
+        view.frameOffsets = reinterpret_cast<const uint32_t*>(column);
+        column += (frames + 1) * sizeof(uint32_t);
+        view.xMin = reinterpret_cast<const int32_t*>(column);
+        column += detections * sizeof(int32_t);
+        view.yMin = reinterpret_cast<const int32_t*>(column);
+        column += detections * sizeof(int32_t);
+        view.xMax = reinterpret_cast<const int32_t*>(column);
+        column += detections * sizeof(int32_t);
+        view.yMax = reinterpret_cast<const int32_t*>(column);
+        column += detections * sizeof(int32_t);
+        view.confidence = reinterpret_cast<const float*>(column);
+        column += detections * sizeof(float);
+        view.classId = reinterpret_cast<const int32_t*>(column);
+
+        m_blocks.push_back(view);
+        m_frameCount += frames;
+        m_detectionCount += detections;
+        offset = payloadOffset + header->payloadBytes;
+    }
+
+    return true;
+}
+
+void DetectionLogReader::Close()
+{
+    if (m_data != nullptr) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+        m_data = nullptr;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_size = 0;
+    m_blocks.clear();
+    m_frameCount = 0;
+    m_detectionCount = 0;
+}
+
+std::vector<LoggedFrame> DetectionLogReader::QueryTimeRange(int64_t begin, int64_t end) const
+{
+    std::vector<LoggedFrame> frames;
+    Query(ANY_CLASS, begin, end, [&frames](const LoggedFrame& frame) { frames.push_back(frame); });
+    return frames;
+}
+
+std::vector<LoggedFrame> DetectionLogReader::QueryClass(int classId, int64_t begin, int64_t end) const
+{
+    std::vector<LoggedFrame> frames;
+    Query(classId, begin, end, [&frames](const LoggedFrame& frame) { frames.push_back(frame); });
+    return frames;
+}
+
+void DetectionLogReader::ForEachFrame(const std::function<void(const LoggedFrame&)>& callback) const
+{
+    Query(ANY_CLASS, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(), callback);
+}
+
+bool DetectionLogReader::ValidOffsets(const BlockView& block)
+{
+    // Checked lazily so Open() keeps reading the block headers only
+    const uint32_t* offsets = block.frameOffsets;
+    uint32_t frameCount = block.header->frameCount;
+    if (offsets[0] != 0 || offsets[frameCount] != block.header->detectionCount) {
+        return false;
+    }
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        if (offsets[i + 1] < offsets[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DetectionLogReader::Query(int classId, int64_t begin, int64_t end,
+                               const std::function<void(const LoggedFrame&)>& callback) const
+{
+    if (begin > end) {
+        return;
+    }
+
+    // First block that may contain timestamps >= begin
+    auto block = std::lower_bound(m_blocks.begin(), m_blocks.end(), begin,
+                                  [](const BlockView& view, int64_t time) {
+                                      return view.header->lastTimestamp < time;
+                                  });
+
+    LoggedFrame frame;
+    for (; block != m_blocks.end() && block->header->firstTimestamp <= end; ++block) {
+        if (classId != ANY_CLASS && !HasClass(block->header->classMask, classId)) {
+            continue;
+        }
+
+        size_t frameCount = block->header->frameCount;
+        if (!ValidOffsets(*block)) {
+            std::cerr << "Skipping detection log block with corrupted frame offsets" << std::endl;
+            continue;
+        }
+
+        size_t first = std::lower_bound(block->timestamps, block->timestamps + frameCount, begin) - block->timestamps;
+        for (size_t i = first; i < frameCount && block->timestamps[i] <= end; ++i) {
+            frame.frameIndex = block->frameIndex[i];
+            frame.timestamp = block->timestamps[i];
+            frame.detections.clear();
+
+            for (uint32_t d = block->frameOffsets[i]; d < block->frameOffsets[i + 1]; ++d) {
+                if (classId != ANY_CLASS && block->classId[d] != classId) {
+                    continue;
+                }
+                frame.detections.push_back({block->xMin[d], block->yMin[d],
+                                            block->xMax[d], block->yMax[d],
+                                            block->confidence[d], block->classId[d]});
+            }
+
+            // Class queries only report frames containing the class
+            if (classId == ANY_CLASS || !frame.detections.empty()) {
+                callback(frame);
+            }
+        }
+    }
+}
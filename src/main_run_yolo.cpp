@@ -5,17 +5,31 @@
 #include <iostream>
 #include <cstdlib>
 #include <chrono>
+#include <algorithm>
+#include <string>
 #include "yolo_11_object_detector.hpp"
 #include "coco_classes.hpp"
+#include "motion_gate.hpp"
+#include "detection_log.hpp"
 
 
 
 void printUsage(const char* programName) {
-    std::cout << "Usage: " << programName << " <use_cuda> <model_path> <video_path>" << std::endl;
+    MotionGateConfig defaults;
+    std::cout << "Usage: " << programName << " <use_cuda> <model_path> <video_path> [key=value ...]" << std::endl;
     std::cout << "Arguments:" << std::endl;
     std::cout << "  use_cuda  : Use CUDA (true or false)" << std::endl;
     std::cout << "  model_path  : Path to the ONNX model" << std::endl;
     std::cout << "  video_path  : Path to the video file or camera index (0 for default camera)" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  motion_threshold=<int>  : Gray-level change enabling the motion gate (default 0, disabled)" << std::endl;
+    std::cout << "  min_changed_fraction=<float>  : Changed-pixel fraction below which a frame is static (default " << defaults.minChangedFraction << ")" << std::endl;
+    std::cout << "  full_frame_fraction=<float>  : Region area fraction above which the full frame is used (default " << defaults.fullFrameFraction << ")" << std::endl;
+    std::cout << "  roi_margin=<int>  : Margin in pixels around the changed region (default " << defaults.roiMargin << ")" << std::endl;
+    std::cout << "  min_roi_size=<int>  : Minimum region side in pixels (default " << defaults.minRoiSize << ")" << std::endl;
+    std::cout << "  keyframe_interval=<int>  : Force a full-frame inference every N frames, 0 disables (default " << defaults.keyframeInterval << ")" << std::endl;
+    std::cout << "  downsample_width=<int>  : Width of the motion difference image (default " << defaults.downsampleWidth << ")" << std::endl;
+    std::cout << "  detection_log=<path>  : Binary log receiving the detections of every frame" << std::endl;
 }
 
 int main(int argc, char** argv)
@@ -31,6 +45,60 @@ int main(int argc, char** argv)
     std::cout << "  Model path: " << argv[2] << std::endl;
     std::cout << "  Video path: " << argv[3] << std::endl;
 
+    // Parse the optional key=value arguments
+    int motionThreshold = 0;
+    MotionGateConfig motionConfig;
+    std::string detectionLogPath;
+    for (int i = 4; i < argc; ++i) {
+        std::string option = argv[i];
+        size_t separator = option.find('=');
+        std::string key = option.substr(0, separator);
+        const char* value = (separator != std::string::npos) ? argv[i] + separator + 1 : nullptr;
+
+        if (value == nullptr) {
+            std::cerr << "Error: option without value: " << option << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        } else if (key == "motion_threshold") {
+            motionThreshold = atoi(value);
+        } else if (key == "min_changed_fraction") {
+            motionConfig.minChangedFraction = static_cast<float>(atof(value));
+        } else if (key == "full_frame_fraction") {
+            motionConfig.fullFrameFraction = static_cast<float>(atof(value));
+        } else if (key == "roi_margin") {
+            motionConfig.roiMargin = atoi(value);
+        } else if (key == "min_roi_size") {
+            motionConfig.minRoiSize = atoi(value);
+        } else if (key == "keyframe_interval") {
+            motionConfig.keyframeInterval = atoi(value);
+        } else if (key == "downsample_width") {
+            motionConfig.downsampleWidth = std::max(1, atoi(value));
+        } else if (key == "detection_log") {
+            detectionLogPath = value;
+        } else {
+            std::cerr << "Error: unknown option: " << key << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Optional motion gate, only useful for fixed cameras
+    bool useMotionGate = motionThreshold > 0;
+    motionConfig.pixelThreshold = motionThreshold;
+    MotionGate motionGate(motionConfig);
+    if (useMotionGate) {
+        std::cout << "  Motion gate threshold: " << motionThreshold << std::endl;
+    }
+
+    // Optional binary detection log, written on a background thread
+    DetectionLogWriter detectionLog;
+    if (!detectionLogPath.empty()) {
+        std::cout << "  Detection log: " << detectionLogPath << std::endl;
+        if (!detectionLog.Open(detectionLogPath)) {
+            return -1;
+        }
+    }
+
     // Initialize YOLO detector
     Yolo11ObjectDetector yolo_model;
     yolo_model.ConfigureSession(atoi(argv[1]));
@@ -82,8 +150,11 @@ int main(int argc, char** argv)
     int framesSinceLastFPS = 0;
     float currentFPS = 0.0f;
     bool success = false;
+    auto captureStartTime = std::chrono::steady_clock::now();
 
     std::vector<BoundingBox> finalDetections;
+    MotionGate::Decision decision = MotionGate::Decision::FullFrame;
+    cv::Rect roi;
     
     while(1) {
         // Capture new frame
@@ -107,16 +178,32 @@ int main(int argc, char** argv)
             startTime = currentTime;
         }
 
-        // Run object detection
-        success = yolo_model.DetectObjects(frame, outputTensor);
+        // Decide whether (and where) to run inference on this frame
+        if (useMotionGate) {
+            decision = motionGate.Update(frame, finalDetections, roi);
+        } else {
+            roi = cv::Rect(0, 0, frame.cols, frame.rows);
+        }
+
+        // Run object detection, static frames reuse the last detections
+        if (decision == MotionGate::Decision::Skip) {
+            success = true;
+        } else {
+            success = yolo_model.DetectObjects(frame, roi, outputTensor);
+            if (success) {
+                // Get the output tensor data
+                float* Result = outputTensor.front().GetTensorMutableData<float>();
+
+                std::vector<BoundingBox> detections = yolo_model.ParseOutput(Result, width, height);
+                finalDetections = motionGate.MergeDetections(finalDetections, detections, roi);
+                outputTensor.clear();
+                motionGate.Commit();
+            }
+        }
+
         if (success) {
             numObjectsDetected = 0;
 
-            // Get the output tensor data
-            float* Result = outputTensor.front().GetTensorMutableData<float>();
-
-            finalDetections = yolo_model.ParseOutput(Result, width, height);
-              
             // Drawing the boxes from finalDetections
             for (const auto& detection : finalDetections) {
                 // Draw the bounding box
@@ -137,7 +224,17 @@ int main(int argc, char** argv)
 
                 numObjectsDetected++;
             }
-            outputTensor.clear();
+
+            // Log the detections, video files use their own timeline
+            if (detectionLog.IsOpen()) {
+                int64_t timestamp = isCamera
+                    ? std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - captureStartTime).count()
+                    : static_cast<int64_t>(cap.get(cv::CAP_PROP_POS_MSEC));
+                if (!detectionLog.Append(frameCount, timestamp, finalDetections)) {
+                    std::cerr << "Error: detection log write failed, logging stopped" << std::endl;
+                    detectionLog.Close();
+                }
+            }
 
             std::cout << "Detected " << numObjectsDetected << " objects" << std::endl;
         }
@@ -146,6 +243,17 @@ int main(int argc, char** argv)
         std::string fpsText = "FPS: " + std::to_string(static_cast<int>(currentFPS));
         cv::putText(frame, fpsText, cv::Point(10, 30), cv::FONT_HERSHEY_DUPLEX, 0.5, cv::Scalar(0, 255, 0), 1);
 
+        // Display the motion gate skip rate and the inference region
+        if (useMotionGate) {
+            std::string skipText = "Skipped: " + std::to_string(static_cast<int>(motionGate.GetSkipRate() * 100)) + "%";
+            cv::putText(frame, skipText, cv::Point(10, 50), cv::FONT_HERSHEY_DUPLEX, 0.5, cv::Scalar(0, 255, 0), 1);
+            std::string gateText = "Gate: " + std::to_string(static_cast<int>(motionGate.GetLastGateMicros())) + " us";
+            cv::putText(frame, gateText, cv::Point(10, 70), cv::FONT_HERSHEY_DUPLEX, 0.5, cv::Scalar(0, 255, 0), 1);
+            if (decision == MotionGate::Decision::Roi) {
+                cv::rectangle(frame, roi, cv::Scalar(0, 255, 255), 1);
+            }
+        }
+
         // Display the frame
         cv::imshow("Video Stream", frame);
 
@@ -157,8 +265,15 @@ int main(int argc, char** argv)
     }
 
     std::cout << "Total frames processed: " << frameCount << std::endl;
+    if (useMotionGate) {
+        std::cout << "Motion gate: " << motionGate.GetFramesSkipped() << " frames skipped, "
+                  << motionGate.GetRoiFrames() << " region-only frames, skip rate "
+                  << motionGate.GetSkipRate() * 100.0f << "%, average gate time "
+                  << motionGate.GetAverageGateMicros() << " us" << std::endl;
+    }
 
     // Release the capture and destroy windows
+    detectionLog.Close();
     cap.release();
     cv::destroyAllWindows();
 
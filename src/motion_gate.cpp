@@ -0,0 +1,214 @@
+#include "../include/motion_gate.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+
+MotionGate::MotionGate(const MotionGateConfig& config) : m_config(config)
+{
+    Reset();
+}
+
+void MotionGate::Reset()
+{
+    m_reference.release();
+    m_hasPending = false;
+    m_framesSinceFull = 0;
+    m_framesProcessed = 0;
+    m_framesSkipped = 0;
+    m_roiFrames = 0;
+    m_lastGateMicros = 0.0;
+    m_totalGateMicros = 0.0;
+}
+
+float MotionGate::GetSkipRate() const
+{
+    if (m_framesProcessed == 0)
+    {
+        return 0.0f;
+    }
+    return static_cast<float>(m_framesSkipped) / m_framesProcessed;
+}
+
+double MotionGate::GetAverageGateMicros() const
+{
+    if (m_framesProcessed == 0)
+    {
+        return 0.0;
+    }
+    return m_totalGateMicros / m_framesProcessed;
+}
+
+MotionGate::Decision MotionGate::Update(const cv::Mat& frame,
+                                       const std::vector<BoundingBox>& previous,
+                                       cv::Rect& roi)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    m_framesProcessed++;
+    m_hasPending = false;
+    roi = cv::Rect(0, 0, frame.cols, frame.rows);
+    Decision decision = Decide(frame, previous, roi);
+
+    m_lastGateMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    m_totalGateMicros += m_lastGateMicros;
+    return decision;
+}
+
+MotionGate::Decision MotionGate::Decide(const cv::Mat& frame,
+                                        const std::vector<BoundingBox>& previous,
+                                        cv::Rect& roi)
+{
+    // Downsample before the color conversion so every step runs on a few thousand pixels
+    int smallW = std::min(m_config.downsampleWidth, frame.cols);
+    int smallH = std::max(1, cvRound(static_cast<double>(frame.rows) * smallW / frame.cols));
+
+    // Strided nearest sampling to twice the target size only touches the sampled pixels;
+    // the 2x INTER_AREA step then averages out the sampling noise on the vectorized path
+    cv::Size decimatedSize(std::min(frame.cols, 2 * smallW), std::min(frame.rows, 2 * smallH));
+    if (decimatedSize != frame.size()) {
+        cv::resize(frame, m_decimated, decimatedSize, 0, 0, cv::INTER_NEAREST);
+        cv::resize(m_decimated, m_resized, cv::Size(smallW, smallH), 0, 0, cv::INTER_AREA);
+    } else {
+        cv::resize(frame, m_resized, cv::Size(smallW, smallH), 0, 0, cv::INTER_AREA);
+    }
+
+    if (m_resized.channels() == 3) {
+        cv::cvtColor(m_resized, m_gray, cv::COLOR_BGR2GRAY);
+    } else if (m_resized.channels() == 4) {
+        cv::cvtColor(m_resized, m_gray, cv::COLOR_BGRA2GRAY);
+    } else {
+        m_resized.copyTo(m_gray);
+    }
+
+    // First frame, resolution change or periodic keyframe: run the full frame
+    bool keyframe = m_config.keyframeInterval > 0 && m_framesSinceFull >= m_config.keyframeInterval;
+    if (m_reference.empty() || m_reference.size() != m_gray.size() || keyframe) {
+        m_pendingDecision = Decision::FullFrame;
+        m_hasPending = true;
+        return Decision::FullFrame;
+    }
+
+    // Compare against the last frame that was sent to inference
+    cv::absdiff(m_gray, m_reference, m_diff);
+    cv::threshold(m_diff, m_mask, m_config.pixelThreshold, 255, cv::THRESH_BINARY);
+
+    int changedPixels = cv::countNonZero(m_mask);
+    if (changedPixels < m_config.minChangedFraction * m_mask.total()) {
+        m_framesSinceFull++;
+        m_framesSkipped++;
+        return Decision::Skip;
+    }
+
+    // The bounding box of all changed pixels is the union of the changed regions
+    cv::Rect changed = cv::boundingRect(m_mask);
+    float scaleX = static_cast<float>(frame.cols) / m_mask.cols;
+    float scaleY = static_cast<float>(frame.rows) / m_mask.rows;
+    cv::Rect changedFull(static_cast<int>(std::floor(changed.x * scaleX)),
+                         static_cast<int>(std::floor(changed.y * scaleY)),
+                         static_cast<int>(std::ceil(changed.width * scaleX)),
+                         static_cast<int>(std::ceil(changed.height * scaleY)));
+
+    cv::Rect region = ExpandRegion(changedFull, previous, frame.size());
+    m_hasPending = true;
+    if (region.area() >= m_config.fullFrameFraction * frame.cols * frame.rows) {
+        m_pendingDecision = Decision::FullFrame;
+        return Decision::FullFrame;
+    }
+
+    m_pendingDecision = Decision::Roi;
+    m_framesSinceFull++;
+    m_roiFrames++;
+    roi = region;
+    return Decision::Roi;
+}
+
+void MotionGate::Commit()
+{
+    // Inference on the last Update() succeeded, its frame becomes the new reference
+    if (!m_hasPending) {
+        return;
+    }
+    std::swap(m_reference, m_gray);
+    if (m_pendingDecision == Decision::FullFrame) {
+        m_framesSinceFull = 0;
+    }
+    m_hasPending = false;
+}
+
+cv::Rect MotionGate::ExpandRegion(const cv::Rect& changed,
+                                  const std::vector<BoundingBox>& previous,
+                                  const cv::Size& frameSize) const
+{
+    // Add a margin so objects crossing the region border are not cut off
+    int x0 = changed.x - m_config.roiMargin;
+    int y0 = changed.y - m_config.roiMargin;
+    int x1 = changed.x + changed.width + m_config.roiMargin;
+    int y1 = changed.y + changed.height + m_config.roiMargin;
+
+    // Grow small regions around their center up to the minimum size
+    int minW = std::min(m_config.minRoiSize, frameSize.width);
+    int minH = std::min(m_config.minRoiSize, frameSize.height);
+    if (x1 - x0 < minW) {
+        int cx = (x0 + x1) / 2;
+        x0 = cx - minW / 2;
+        x1 = x0 + minW;
+    }
+    if (y1 - y0 < minH) {
+        int cy = (y0 + y1) / 2;
+        y0 = cy - minH / 2;
+        y1 = y0 + minH;
+    }
+
+    // Shift back inside the frame rather than clipping, to keep the minimum size
+    if (x0 < 0) { x1 -= x0; x0 = 0; }
+    if (y0 < 0) { y1 -= y0; y0 = 0; }
+    if (x1 > frameSize.width) { x0 = std::max(0, x0 - (x1 - frameSize.width)); x1 = frameSize.width; }
+    if (y1 > frameSize.height) { y0 = std::max(0, y0 - (y1 - frameSize.height)); y1 = frameSize.height; }
+
+    // Grow the region over every previous detection it touches, so the crop sees those
+    // objects whole; repeat since each growth step may reach further detections
+    bool grown = true;
+    while (grown) {
+        grown = false;
+        for (const auto& detection : previous) {
+            bool overlaps = detection.x_min < x1 && detection.x_max >= x0 &&
+                            detection.y_min < y1 && detection.y_max >= y0;
+            if (!overlaps) {
+                continue;
+            }
+
+            int nx0 = std::max(0, std::min(x0, detection.x_min));
+            int ny0 = std::max(0, std::min(y0, detection.y_min));
+            int nx1 = std::min(frameSize.width, std::max(x1, detection.x_max + 1));
+            int ny1 = std::min(frameSize.height, std::max(y1, detection.y_max + 1));
+            if (nx0 != x0 || ny0 != y0 || nx1 != x1 || ny1 != y1) {
+                x0 = nx0;
+                y0 = ny0;
+                x1 = nx1;
+                y1 = ny1;
+                grown = true;
+            }
+        }
+    }
+
+    return cv::Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+std::vector<BoundingBox> MotionGate::MergeDetections(const std::vector<BoundingBox>& previous,
+                                                     const std::vector<BoundingBox>& fresh,
+                                                     const cv::Rect& roi) const
+{
+    // Fresh detections replace the previous ones lying fully inside the inference region;
+    // Update() grew the region so that no previous detection straddles its border
+    std::vector<BoundingBox> merged = fresh;
+    for (const auto& detection : previous) {
+        bool inside = detection.x_min >= roi.x && detection.x_max < roi.x + roi.width &&
+                      detection.y_min >= roi.y && detection.y_max < roi.y + roi.height;
+        if (!inside) {
+            merged.push_back(detection);
+        }
+    }
+    return merged;
+}
@@ -11,6 +11,16 @@ std::vector<BoundingBox> Yolo11ObjectDetector::ParseOutput(const float* output,
 
     std::vector<BoundingBox> detections;
 
+    // Boxes are clamped to the inference region, the model never saw pixels outside it
+    float minX = static_cast<float>(m_roiOffset.x);
+    float minY = static_cast<float>(m_roiOffset.y);
+    float maxX = static_cast<float>(imageWidth - 1);
+    float maxY = static_cast<float>(imageHeight - 1);
+    if (!m_roiSize.empty()) {
+        maxX = std::min(maxX, static_cast<float>(m_roiOffset.x + m_roiSize.width - 1));
+        maxY = std::min(maxY, static_cast<float>(m_roiOffset.y + m_roiSize.height - 1));
+    }
+
     for (int i = 0; i < numElements; ++i) {
         float x = output[0 * numElements + i];  // channel 0
         float y = output[1 * numElements + i];  // channel 1
@@ -32,9 +42,9 @@ std::vector<BoundingBox> Yolo11ObjectDetector::ParseOutput(const float* output,
         float confidence = maxScore;
 
         if (confidence > confidenceThreshold) {
-            // Apply letterbox transformation
-            float imageX = (x - m_pad.x) / m_scale;
-            float imageY = (y - m_pad.y) / m_scale;
+            // Apply letterbox transformation (and shift back from the inference region)
+            float imageX = (x - m_pad.x) / m_scale + m_roiOffset.x;
+            float imageY = (y - m_pad.y) / m_scale + m_roiOffset.y;
             float imageW = w / m_scale;
             float imageH = h / m_scale;
 
@@ -43,11 +53,11 @@ std::vector<BoundingBox> Yolo11ObjectDetector::ParseOutput(const float* output,
             float xMax = imageX + (imageW / 2.0f);
             float yMax = imageY + (imageH / 2.0f);
             
-            // Clamp to image bounds
-            xMin = std::clamp(xMin, 0.0f, static_cast<float>(imageWidth - 1));
-            yMin = std::clamp(yMin, 0.0f, static_cast<float>(imageHeight - 1));
-            xMax = std::clamp(xMax, 0.0f, static_cast<float>(imageWidth - 1));
-            yMax = std::clamp(yMax, 0.0f, static_cast<float>(imageHeight - 1));
+            // Clamp to the inference region (the whole image unless running on a region)
+            xMin = std::clamp(xMin, minX, maxX);
+            yMin = std::clamp(yMin, minY, maxY);
+            xMax = std::clamp(xMax, minX, maxX);
+            yMax = std::clamp(yMax, minY, maxY);
 
             detections.push_back({static_cast<int>(xMin),
                                 static_cast<int>(yMin),
@@ -87,9 +87,23 @@ bool YoloObjectDetector::PreprocessImage(const cv::Mat& image, std::vector<Ort::
 
 bool YoloObjectDetector::DetectObjects(const cv::Mat& image, std::vector<Ort::Value>& outputTensor)
 {
+    return DetectObjects(image, cv::Rect(0, 0, image.cols, image.rows), outputTensor);
+}
+
+bool YoloObjectDetector::DetectObjects(const cv::Mat& image, const cv::Rect& roi, std::vector<Ort::Value>& outputTensor)
+{
+    // Clip the region to the image and remember its offset for ParseOutput()
+    cv::Rect region = roi & cv::Rect(0, 0, image.cols, image.rows);
+    if (region.empty())
+    {
+        return false;
+    }
+    m_roiOffset = region.tl();
+    m_roiSize = region.size();
+
     // Preprocess the image
     std::vector<Ort::Value> inputTensor;
-    bool success = PreprocessImage(image, inputTensor);
+    bool success = PreprocessImage(image(region), inputTensor);
     if (!success)
     {
         return false;
@@ -0,0 +1,233 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "detection_log.hpp"
+
+// Round-trip check of the detection log format, builds without ONNX Runtime or OpenCV
+
+namespace {
+    // ================================
+    // Constants
+    // ================================
+    constexpr size_t FRAMES_PER_BLOCK = 4;
+    constexpr int FRAME_COUNT = 10;   // Blocks of 4, 4 and a partial block of 2
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            failures++;
+        }
+    }
+
+    // Frame i has i % 3 detections (every third frame is empty), with unusual class ids mixed in
+    std::vector<BoundingBox> makeDetections(int frame) {
+        static const int classIds[] = {0, 5, -1, 127, 200, 79};
+        std::vector<BoundingBox> detections;
+        for (int k = 0; k < frame % 3; ++k) {
+            int classId = classIds[(frame + k) % 6];
+            detections.push_back({frame, k, frame + 10, k + 10, 0.25f * (k + 1), classId});
+        }
+        return detections;
+    }
+
+    size_t countClass(int classId) {
+        size_t count = 0;
+        for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+            for (const auto& detection : makeDetections(frame)) {
+                count += detection.class_id == classId;
+            }
+        }
+        return count;
+    }
+
+    bool writeLog(const std::string& path) {
+        DetectionLogWriter writer;
+        if (!writer.Open(path, FRAMES_PER_BLOCK)) {
+            return false;
+        }
+        for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+            // Frame numbers have gaps, timestamps are 10 ms apart
+            if (!writer.Append(frame * 2 + 1, frame * 10, makeDetections(frame))) {
+                return false;
+            }
+        }
+        writer.Close();
+        return true;
+    }
+
+    std::vector<char> readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void writeFile(const std::string& path, const std::vector<char>& bytes, size_t size) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), size);
+    }
+}
+
+void checkRoundTrip(const std::string& path) {
+    DetectionLogReader reader;
+    check(reader.Open(path), "open written log");
+    check(reader.GetBlockCount() == 3, "two full blocks and a partial one");
+    check(reader.GetFrameCount() == FRAME_COUNT, "frame count");
+
+    // Full scan returns every frame with its detections unchanged
+    int frame = 0;
+    reader.ForEachFrame([&frame](const LoggedFrame& logged) {
+        std::vector<BoundingBox> expected = makeDetections(frame);
+        check(logged.frameIndex == static_cast<uint64_t>(frame * 2 + 1), "frame index");
+        check(logged.timestamp == frame * 10, "timestamp");
+        check(logged.detections.size() == expected.size(), "detection count of frame " + std::to_string(frame));
+        for (size_t i = 0; i < expected.size() && i < logged.detections.size(); ++i) {
+            const BoundingBox& a = logged.detections[i];
+            const BoundingBox& b = expected[i];
+            check(a.x_min == b.x_min && a.y_min == b.y_min && a.x_max == b.x_max && a.y_max == b.y_max &&
+                  a.confidence == b.confidence && a.class_id == b.class_id, "detection values");
+        }
+        frame++;
+    });
+    check(frame == FRAME_COUNT, "full scan visits every frame");
+
+    // Inclusive bounds, spanning the first and second block
+    std::vector<LoggedFrame> range = reader.QueryTimeRange(30, 50);
+    check(range.size() == 3 && range.front().timestamp == 30 && range.back().timestamp == 50, "time range 30..50");
+    check(reader.QueryTimeRange(31, 39).empty(), "time range between frames");
+    check(reader.QueryTimeRange(1000, 2000).empty(), "time range after the log");
+    check(reader.QueryTimeRange(50, 30).empty(), "reversed time range");
+    check(reader.QueryTimeRange(-100, 0).size() == 1, "time range ending at the first frame");
+
+    // Class queries return only the requested class, including ids sharing the overflow bit
+    for (int classId : {0, 5, -1, 127, 200, 79, 3}) {
+        size_t detections = 0;
+        bool onlyClass = true;
+        for (const auto& logged : reader.QueryClass(classId)) {
+            onlyClass = onlyClass && !logged.detections.empty();
+            for (const auto& detection : logged.detections) {
+                onlyClass = onlyClass && detection.class_id == classId;
+                detections++;
+            }
+        }
+        check(onlyClass, "class query " + std::to_string(classId) + " returns only that class");
+        check(detections == countClass(classId), "class query " + std::to_string(classId) + " count");
+    }
+    size_t inRange = 0;
+    for (const auto& logged : reader.QueryClass(127, 0, 40)) {
+        check(logged.timestamp >= 0 && logged.timestamp <= 40, "class query respects the time range");
+        inRange++;
+    }
+    check(inRange == 1, "class query 127 within 0..40");
+}
+
+void checkTimestampClamping(const std::string& path) {
+    {
+        DetectionLogWriter writer;
+        writer.Open(path, 2);
+        const int64_t timestamps[] = {100, 200, 50, 60};
+        for (int i = 0; i < 4; ++i) {
+            writer.Append(i, timestamps[i], {});
+        }
+    }
+
+    DetectionLogReader reader;
+    check(reader.Open(path), "open clamped log");
+    check(reader.QueryTimeRange(200, 200).size() == 3, "backwards timestamps are clamped to the last one");
+    check(reader.QueryTimeRange(0, 199).size() == 1, "clamped log stays sorted");
+}
+
+void checkFlush(const std::string& path) {
+    DetectionLogWriter writer;
+    writer.Open(path, FRAMES_PER_BLOCK);
+    for (int frame = 0; frame < 6; ++frame) {
+        writer.Append(frame, frame, makeDetections(frame));
+    }
+    check(writer.Flush(), "flush succeeds");
+
+    // Everything appended before Flush() is readable while the writer is still open
+    DetectionLogReader reader;
+    check(reader.Open(path), "open flushed log");
+    check(reader.GetFrameCount() == 6, "flushed frames are on disk");
+    writer.Close();
+}
+
+void checkEmptyLog(const std::string& path) {
+    {
+        DetectionLogWriter writer;
+        writer.Open(path);
+    }
+
+    DetectionLogReader reader;
+    check(reader.Open(path), "open empty log");
+    check(reader.GetFrameCount() == 0 && reader.QueryTimeRange(0, 100).empty(), "empty log has no frames");
+}
+
+void checkDamagedLogs(const std::string& path, const std::string& damagedPath) {
+    std::vector<char> bytes = readFile(path);
+
+    // Truncated inside the partial last block: the two full blocks remain readable
+    writeFile(damagedPath, bytes, bytes.size() - 8);
+    {
+        DetectionLogReader reader;
+        check(reader.Open(damagedPath), "open truncated log");
+        check(reader.GetBlockCount() == 2 && reader.GetFrameCount() == 2 * FRAMES_PER_BLOCK, "truncated block ignored");
+    }
+
+    // Bad file magic is rejected
+    std::vector<char> badMagic = bytes;
+    badMagic[0] = 'X';
+    writeFile(damagedPath, badMagic, badMagic.size());
+    {
+        DetectionLogReader reader;
+        check(!reader.Open(damagedPath), "bad magic rejected");
+    }
+
+    // frame_offsets[1] of the first block points past its detections: the block is skipped
+    std::vector<char> badOffsets = bytes;
+    size_t offsetPosition = sizeof(DetectionLogFileHeader) + sizeof(DetectionLogBlockHeader) +
+                            FRAMES_PER_BLOCK * (sizeof(uint64_t) + sizeof(int64_t)) + sizeof(uint32_t);
+    uint32_t badOffset = 100000;
+    std::memcpy(badOffsets.data() + offsetPosition, &badOffset, sizeof(badOffset));
+    writeFile(damagedPath, badOffsets, badOffsets.size());
+    {
+        DetectionLogReader reader;
+        check(reader.Open(damagedPath), "open log with corrupted offsets");
+        size_t frames = 0;
+        reader.ForEachFrame([&frames](const LoggedFrame&) { frames++; });
+        check(frames == FRAME_COUNT - FRAMES_PER_BLOCK, "block with corrupted offsets skipped");
+        check(reader.QueryTimeRange(0, 30).empty(), "time range inside the corrupted block");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string dir = (argc > 1) ? argv[1] : ".";
+    std::string path = dir + "/detection_log_check.ydl";
+    std::string damagedPath = dir + "/detection_log_check_damaged.ydl";
+
+    if (!writeLog(path)) {
+        std::cerr << "FAILED: could not write " << path << std::endl;
+        return 1;
+    }
+    checkRoundTrip(path);
+    checkDamagedLogs(path, damagedPath);
+    checkTimestampClamping(path);
+    checkFlush(path);
+    checkEmptyLog(path);
+
+    std::remove(path.c_str());
+    std::remove(damagedPath.c_str());
+
+    if (failures > 0) {
+        std::cerr << failures << " detection log check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Detection log checks passed" << std::endl;
+    return 0;
+}
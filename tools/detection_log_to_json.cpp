@@ -0,0 +1,109 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include "detection_log.hpp"
+#include "coco_classes.hpp"
+
+
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " <log_path> [output_path] [--class <id>] [--from <ms>] [--to <ms>]" << std::endl;
+    std::cout << "Arguments:" << std::endl;
+    std::cout << "  log_path  : Path to the binary detection log" << std::endl;
+    std::cout << "  output_path  : Path to the JSON output (stdout if omitted)" << std::endl;
+    std::cout << "  --class  : Only export detections of this class id" << std::endl;
+    std::cout << "  --from / --to  : Only export frames within this timestamp range (inclusive)" << std::endl;
+}
+
+void writeFrame(std::ostream& out, const LoggedFrame& frame, bool first) {
+    out << (first ? "\n" : ",\n")
+        << "    {\"frame\": " << frame.frameIndex
+        << ", \"timestamp\": " << frame.timestamp
+        << ", \"detections\": [";
+
+    for (size_t i = 0; i < frame.detections.size(); ++i) {
+        const BoundingBox& detection = frame.detections[i];
+        bool known = detection.class_id >= 0 && detection.class_id < static_cast<int>(coco::CLASS_NAMES.size());
+
+        out << (i == 0 ? "" : ", ")
+            << "{\"x_min\": " << detection.x_min
+            << ", \"y_min\": " << detection.y_min
+            << ", \"x_max\": " << detection.x_max
+            << ", \"y_max\": " << detection.y_max
+            << ", \"confidence\": " << detection.confidence
+            << ", \"class_id\": " << detection.class_id
+            << ", \"class_name\": \"" << (known ? coco::CLASS_NAMES[detection.class_id] : "unknown") << "\"}";
+    }
+    out << "]}";
+}
+
+int main(int argc, char** argv)
+{
+    // Check command line arguments
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string outputPath;
+    bool filterClass = false;
+    int classId = 0;
+    int64_t begin = std::numeric_limits<int64_t>::min();
+    int64_t end = std::numeric_limits<int64_t>::max();
+
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--class") == 0 && i + 1 < argc) {
+            filterClass = true;
+            classId = atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            begin = atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            end = atoll(argv[++i]);
+        } else if (outputPath.empty() && argv[i][0] != '-') {
+            outputPath = argv[i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    DetectionLogReader reader;
+    if (!reader.Open(argv[1])) {
+        return -1;
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath);
+        if (!file.is_open()) {
+            std::cerr << "Error opening output file: " << outputPath << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& out = outputPath.empty() ? std::cout : file;
+
+    out << "{\n  \"frames\": [";
+    size_t exported = 0;
+    if (filterClass) {
+        for (const auto& frame : reader.QueryClass(classId, begin, end)) {
+            writeFrame(out, frame, exported++ == 0);
+        }
+    } else if (begin != std::numeric_limits<int64_t>::min() || end != std::numeric_limits<int64_t>::max()) {
+        for (const auto& frame : reader.QueryTimeRange(begin, end)) {
+            writeFrame(out, frame, exported++ == 0);
+        }
+    } else {
+        // Stream the whole log without materializing it
+        reader.ForEachFrame([&out, &exported](const LoggedFrame& frame) {
+            writeFrame(out, frame, exported++ == 0);
+        });
+    }
+    out << "\n  ]\n}" << std::endl;
+
+    std::cerr << "Exported " << exported << " of " << reader.GetFrameCount() << " logged frames" << std::endl;
+
+    return 0;
+}